@@ -1,5 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
+#include <pthread.h>
 
 /* Binary trees are a type of data structure where a node may point to up to two
  * children. Left and right are the terms used to describe the child nodes because
@@ -96,6 +98,14 @@ typedef struct ll_node {
   struct ll_node *next;
 } ll_node;
 
+/* Also borrowed from `./10-linked-lists.c`, this time as-is, so that a sorted list
+ * of values can be turned into a tree
+ */
+typedef struct list_node {
+  int value;
+  struct list_node *next;
+} list_node;
+
 void depthFirstPreOrder(node *x) {
   printf("%d", x->value);
 
@@ -197,6 +207,363 @@ node* getNode(int value) {
   return root;
 }
 
+/* Building a tree one `getNode()` at a time costs one `malloc()` per node, and if
+ * each value is inserted by walking down from the root it costs O(n log n) overall.
+ * When the values are already sorted we can do better: the middle value becomes the
+ * root, the middle of the left half becomes its left child, the middle of the right
+ * half becomes its right child, and so on. Each value is visited exactly once, so
+ * this is O(n), and the result is always balanced.
+ *
+ * Instead of allocating each node separately, all of them are carved out of one
+ * block of `length` nodes. They're laid out in pre-order: the root is at `slot[0]`,
+ * its left subtree takes up the next `left_length` slots, and its right subtree
+ * comes after that. Since the root is the first node in the block, the whole tree
+ * can be released with a single `free(root)` (and *not* with `freeTreeMemory()`,
+ * which would try to free every node on its own).
+ */
+node* buildBalancedSubtree(int *values, node *slot, int length) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  int left_length = (length - 1) / 2;
+
+  slot->value = values[left_length];
+  slot->left = buildBalancedSubtree(values, slot + 1, left_length);
+  slot->right = buildBalancedSubtree(values + left_length + 1, slot + 1 + left_length, length - left_length - 1);
+
+  return slot;
+}
+
+node* buildBalancedTree(int *values, int length) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  node *nodes = malloc(length * sizeof(node));
+
+  return buildBalancedSubtree(values, nodes, length);
+}
+
+/* The same idea works for a sorted linked list, even though we can't jump straight
+ * to the middle of one. If we build the left subtree first, the values are used in
+ * exactly the order the list gives them to us (this is an in-order traversal), so
+ * we only ever need to look at the current node of the list and move `cursor` ahead
+ * by one after each value is placed.
+ */
+node* buildBalancedSubtreeFromList(list_node **cursor, node *slot, int length) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  int left_length = (length - 1) / 2;
+
+  slot->left = buildBalancedSubtreeFromList(cursor, slot + 1, left_length);
+
+  slot->value = (*cursor)->value;
+  *cursor = (*cursor)->next;
+
+  slot->right = buildBalancedSubtreeFromList(cursor, slot + 1 + left_length, length - left_length - 1);
+
+  return slot;
+}
+
+node* buildBalancedTreeFromList(list_node *head, int length) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  node *nodes = malloc(length * sizeof(node));
+
+  return buildBalancedSubtreeFromList(&head, nodes, length);
+}
+
+/* Because every node's slot in the block is known ahead of time, the left and right
+ * halves never touch the same memory and can be built at the same time. At each
+ * of the first `depth` levels the left half is handed off to a new thread while the
+ * current thread builds the right half, so `depth` levels use up to `2^depth`
+ * threads. (This needs to be compiled with `-pthread`.)
+ */
+typedef struct {
+  int *values;
+  node *slot;
+  int length;
+  int depth;
+} build_job;
+
+void* buildBalancedSubtreeParallel(void *arg) {
+  build_job *job = arg;
+
+  if (job->depth <= 0 || job->length <= 1) {
+    buildBalancedSubtree(job->values, job->slot, job->length);
+
+    return NULL;
+  }
+
+  int left_length = (job->length - 1) / 2;
+  node *slot = job->slot;
+
+  build_job left = {job->values, slot + 1, left_length, job->depth - 1};
+  build_job right = {job->values + left_length + 1, slot + 1 + left_length, job->length - left_length - 1, job->depth - 1};
+
+  pthread_t left_thread;
+  int spawned = pthread_create(&left_thread, NULL, buildBalancedSubtreeParallel, &left) == 0;
+
+  // If the thread couldn't be started, just do the work on this one instead
+  if (!spawned) {
+    buildBalancedSubtreeParallel(&left);
+  }
+
+  buildBalancedSubtreeParallel(&right);
+
+  if (spawned) {
+    pthread_join(left_thread, NULL);
+  }
+
+  slot->value = job->values[left_length];
+  slot->left = left_length > 0 ? slot + 1 : NULL;
+  slot->right = right.length > 0 ? slot + 1 + left_length : NULL;
+
+  return NULL;
+}
+
+node* buildBalancedTreeParallel(int *values, int length, int depth) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  node *nodes = malloc(length * sizeof(node));
+  build_job job = {values, nodes, length, depth};
+
+  buildBalancedSubtreeParallel(&job);
+
+  return nodes;
+}
+
+/* Finding the depth of a tree, checking whether it's balanced, or asking "what's
+ * the k'th smallest value?" all mean walking every node with one of the traversals
+ * above. If each node also remembers how many nodes are in its subtree (`size`)
+ * and how tall its subtree is (`height`), those questions can be answered by
+ * looking at a single path from the root instead.
+ *
+ * Both numbers only depend on a node's children, so whenever a child changes they
+ * can be recomputed in O(1) with `updateRankedNode()`. Here `height` counts nodes
+ * rather than edges so that a missing child can be treated as 0 and a leaf as 1;
+ * the depth described at the top of this file is `height - 1`.
+ *
+ * To keep the paths O(log n) long, `insertRanked()` and `removeRanked()` rotate
+ * nodes as they go so that every node stays balanced (this is an AVL tree). The
+ * values are kept in binary search tree order: smaller values to the left, larger
+ * ones to the right.
+ */
+typedef struct ranked_node {
+  int value;
+  int size;
+  int height;
+  struct ranked_node *left;
+  struct ranked_node *right;
+} ranked_node;
+
+int rankedSize(ranked_node *x) {
+  return x == NULL ? 0 : x->size;
+}
+
+int rankedHeight(ranked_node *x) {
+  return x == NULL ? 0 : x->height;
+}
+
+// Positive when the left side is taller, negative when the right side is
+int rankedBalance(ranked_node *x) {
+  return x == NULL ? 0 : rankedHeight(x->left) - rankedHeight(x->right);
+}
+
+void updateRankedNode(ranked_node *x) {
+  int left_height = rankedHeight(x->left);
+  int right_height = rankedHeight(x->right);
+
+  x->size = rankedSize(x->left) + rankedSize(x->right) + 1;
+  x->height = (left_height > right_height ? left_height : right_height) + 1;
+}
+
+/* A rotation swaps a node with one of its children while keeping the values in
+ * order. For a right rotation of `x`, its left child `y` takes its place:
+ *
+ *         x               y
+ *        / \             / \
+ *       y   c    -->    a   x
+ *      / \                 / \
+ *     a   b               b   c
+ *
+ * Only `x` and `y` get new children, so they're the only ones that need updating
+ * (`x` first, since it's now below `y`).
+ */
+ranked_node* rotateRight(ranked_node *x) {
+  ranked_node *y = x->left;
+
+  x->left = y->right;
+  y->right = x;
+
+  updateRankedNode(x);
+  updateRankedNode(y);
+
+  return y;
+}
+
+ranked_node* rotateLeft(ranked_node *x) {
+  ranked_node *y = x->right;
+
+  x->right = y->left;
+  y->left = x;
+
+  updateRankedNode(x);
+  updateRankedNode(y);
+
+  return y;
+}
+
+ranked_node* rebalanceRanked(ranked_node *x) {
+  updateRankedNode(x);
+
+  int balance = rankedBalance(x);
+
+  if (balance > 1) {
+    if (rankedBalance(x->left) < 0) {
+      x->left = rotateLeft(x->left);
+    }
+
+    return rotateRight(x);
+  }
+
+  if (balance < -1) {
+    if (rankedBalance(x->right) > 0) {
+      x->right = rotateRight(x->right);
+    }
+
+    return rotateLeft(x);
+  }
+
+  return x;
+}
+
+/* Returns the new root of the subtree, which may be different from `root` if it
+ * had to be rotated. Duplicate values are ignored.
+ */
+ranked_node* insertRanked(int value, ranked_node *root) {
+  if (root == NULL) {
+    ranked_node *n = malloc(sizeof(ranked_node));
+
+    n->value = value;
+    n->size = 1;
+    n->height = 1;
+    n->left = NULL;
+    n->right = NULL;
+
+    return n;
+  }
+
+  if (value < root->value) {
+    root->left = insertRanked(value, root->left);
+  } else if (value > root->value) {
+    root->right = insertRanked(value, root->right);
+  } else {
+    return root;
+  }
+
+  return rebalanceRanked(root);
+}
+
+ranked_node* removeRanked(int value, ranked_node *root) {
+  if (root == NULL) {
+    return NULL;
+  }
+
+  if (value < root->value) {
+    root->left = removeRanked(value, root->left);
+  } else if (value > root->value) {
+    root->right = removeRanked(value, root->right);
+  } else if (root->left == NULL || root->right == NULL) {
+    ranked_node *child = root->left != NULL ? root->left : root->right;
+
+    free(root);
+
+    return child;
+  } else {
+    // Swap in the smallest value from the right subtree and remove that one instead
+    ranked_node *successor = root->right;
+
+    while (successor->left != NULL) {
+      successor = successor->left;
+    }
+
+    root->value = successor->value;
+    root->right = removeRanked(successor->value, root->right);
+  }
+
+  return rebalanceRanked(root);
+}
+
+/* Returns the k'th smallest value (starting at 0). The left subtree holds the
+ * `rankedSize(x->left)` smallest values, so we can tell which side of `x` the
+ * answer is on without visiting either of them. `k` must be less than the size
+ * of the tree.
+ */
+int selectRanked(int k, ranked_node *x) {
+  while (x != NULL) {
+    int left_size = rankedSize(x->left);
+
+    if (k < left_size) {
+      x = x->left;
+    } else if (k > left_size) {
+      k -= left_size + 1;
+      x = x->right;
+    } else {
+      break;
+    }
+  }
+
+  return x->value;
+}
+
+/* Returns how many values in the tree are less than `value`. Every time we go
+ * right, the node we came from and its whole left subtree are smaller.
+ */
+int rankOfValue(int value, ranked_node *x) {
+  int rank = 0;
+
+  while (x != NULL) {
+    if (value <= x->value) {
+      x = x->left;
+    } else {
+      rank += rankedSize(x->left) + 1;
+      x = x->right;
+    }
+  }
+
+  return rank;
+}
+
+// Returns how many values fall within `low` and `high` (inclusive)
+int countRange(int low, int high, ranked_node *x) {
+  if (low > high) {
+    return 0;
+  }
+
+  int rank_of_high = high == INT_MAX ? rankedSize(x) : rankOfValue(high + 1, x);
+
+  return rank_of_high - rankOfValue(low, x);
+}
+
+void freeRankedTree(ranked_node *root) {
+  if (root == NULL) {
+    return;
+  }
+
+  freeRankedTree(root->left);
+  freeRankedTree(root->right);
+
+  free(root);
+}
+
 int main() {
   node *root = getNode(1);
 
@@ -223,4 +590,47 @@ int main() {
   printf("\n");
 
   freeTreeMemory(root);
+
+  int sorted[] = {1, 2, 3, 4, 5, 6, 7};
+
+  printf("\nBalanced tree built from a sorted array (pre-order):\n");
+  root = buildBalancedTree(sorted, 7);
+  depthFirstPreOrder(root);
+  printf("\n");
+  free(root);
+
+  list_node list[7];
+
+  for (int i = 0; i < 7; i++) {
+    list[i].value = sorted[i];
+    list[i].next = i < 6 ? &list[i + 1] : NULL;
+  }
+
+  printf("\nBalanced tree built from a sorted list (pre-order):\n");
+  root = buildBalancedTreeFromList(list, 7);
+  depthFirstPreOrder(root);
+  printf("\n");
+  free(root);
+
+  printf("\nBalanced tree built on multiple threads (pre-order):\n");
+  root = buildBalancedTreeParallel(sorted, 7, 2);
+  depthFirstPreOrder(root);
+  printf("\n");
+  free(root);
+
+  ranked_node *ranked = NULL;
+
+  for (int i = 1; i <= 10; i++) {
+    ranked = insertRanked(i * 10, ranked);
+  }
+
+  ranked = removeRanked(40, ranked);
+
+  printf("\nRanked tree of %d values with a depth of %d and a balance of %d\n",
+    rankedSize(ranked), rankedHeight(ranked) - 1, rankedBalance(ranked));
+  printf("The 4th smallest value is %d\n", selectRanked(3, ranked));
+  printf("%d values are less than 75\n", rankOfValue(75, ranked));
+  printf("%d values are between 25 and 85\n", countRange(25, 85, ranked));
+
+  freeRankedTree(ranked);
 }
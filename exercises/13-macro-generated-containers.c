@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+/* The list in `./10-linked-lists.c` and the tree in `./11-binary-trees.c` can only
+ * hold `int`s, and the breadth-first search in the tree exercise needed a second,
+ * nearly identical list (`ll_node`) just to hold pointers to tree nodes instead.
+ *
+ * One way around this is to store a `void *` in each node and point it at the real
+ * data, but that means an extra allocation for every element and an extra pointer
+ * to follow every time one is read. Another way is to have the preprocessor write
+ * the code for us: a macro that takes the element type as a parameter can expand
+ * into a struct and a set of functions for that one type. The values are stored
+ * directly inside the nodes, and since the compiler sees the real type it can
+ * inline the comparisons too.
+ *
+ * A few things about the macros below:
+ *
+ *  - `##` pastes two tokens together, so with `name` set to `int_list`, the
+ *    expression `name##_node` becomes `int_list_node`. This is how each expansion
+ *    gets its own set of names that won't clash with the others.
+ *  - A macro has to be on one logical line, so every line but the last ends in a
+ *    backslash.
+ *  - The functions are `static inline` so that expanding the same macro in more
+ *    than one file wouldn't cause duplicate definitions, and so that the compiler
+ *    doesn't warn about any that go unused.
+ *  - `equals` and `compare` are "hooks": the name of a function (or function-like
+ *    macro) that gets pasted into the generated code. `equals(a, b)` should be
+ *    non-zero when `a` and `b` are the same, and `compare(a, b)` should be negative,
+ *    zero or positive like the comparison functions `qsort()` expects.
+ */
+
+/* A singly linked list with the same operations as `./10-linked-lists.c`, plus a
+ * `find()` that uses the `equals` hook.
+ */
+#define DEFINE_LIST(T, name, equals)                                          \
+  typedef struct name##_node {                                                \
+    T value;                                                                  \
+    struct name##_node *next;                                                 \
+  } name##_node;                                                              \
+                                                                              \
+  static inline void name##_prepend(T value, name##_node **head) {            \
+    name##_node *n = malloc(sizeof(name##_node));                             \
+                                                                              \
+    n->value = value;                                                         \
+    n->next = *head;                                                          \
+                                                                              \
+    *head = n;                                                                \
+  }                                                                           \
+                                                                              \
+  static inline void name##_append(T value, name##_node **head) {             \
+    while (*head != NULL) {                                                   \
+      head = &(*head)->next;                                                  \
+    }                                                                         \
+                                                                              \
+    name##_prepend(value, head);                                              \
+  }                                                                           \
+                                                                              \
+  static inline void name##_remove_first(name##_node **head) {                \
+    name##_node *tmp_head = *head;                                            \
+    *head = (*head)->next;                                                    \
+    free(tmp_head);                                                           \
+  }                                                                           \
+                                                                              \
+  static inline name##_node* name##_find(T value, name##_node *head) {        \
+    while (head != NULL && !equals(head->value, value)) {                     \
+      head = head->next;                                                      \
+    }                                                                         \
+                                                                              \
+    return head;                                                              \
+  }                                                                           \
+                                                                              \
+  static inline void name##_free(name##_node **head) {                        \
+    while (*head != NULL) {                                                   \
+      name##_remove_first(head);                                              \
+    }                                                                         \
+  }
+
+/* A first-in, first-out queue. Unlike the `append()` used for the breadth-first
+ * search in `./11-binary-trees.c`, it keeps track of its last node so that pushing
+ * doesn't need to walk the whole queue.
+ */
+#define DEFINE_QUEUE(T, name)                                                 \
+  typedef struct name##_node {                                                \
+    T value;                                                                  \
+    struct name##_node *next;                                                 \
+  } name##_node;                                                              \
+                                                                              \
+  typedef struct {                                                            \
+    name##_node *first;                                                       \
+    name##_node *last;                                                        \
+  } name;                                                                     \
+                                                                              \
+  static inline int name##_is_empty(name *q) {                                \
+    return q->first == NULL;                                                  \
+  }                                                                           \
+                                                                              \
+  static inline void name##_push(T value, name *q) {                          \
+    name##_node *n = malloc(sizeof(name##_node));                             \
+                                                                              \
+    n->value = value;                                                         \
+    n->next = NULL;                                                           \
+                                                                              \
+    if (q->last == NULL) {                                                    \
+      q->first = n;                                                           \
+    } else {                                                                  \
+      q->last->next = n;                                                      \
+    }                                                                         \
+                                                                              \
+    q->last = n;                                                              \
+  }                                                                           \
+                                                                              \
+  /* The queue must not be empty */                                           \
+  static inline T name##_shift(name *q) {                                     \
+    name##_node *n = q->first;                                                \
+    T value = n->value;                                                       \
+                                                                              \
+    q->first = n->next;                                                       \
+                                                                              \
+    if (q->first == NULL) {                                                   \
+      q->last = NULL;                                                         \
+    }                                                                         \
+                                                                              \
+    free(n);                                                                  \
+                                                                              \
+    return value;                                                             \
+  }
+
+/* A dynamic array like the ones in `./09-dynamic-arrays.c` that grows as needed.
+ * Its capacity doubles whenever it fills up, so pushing `n` values only copies
+ * the array O(log n) times.
+ */
+#define DEFINE_VECTOR(T, name, equals)                                        \
+  typedef struct {                                                            \
+    T *items;                                                                 \
+    size_t length;                                                            \
+    size_t capacity;                                                          \
+  } name;                                                                     \
+                                                                              \
+  /* Returns 0 if the array couldn't be grown */                              \
+  static inline int name##_push(T value, name *v) {                           \
+    if (v->length == v->capacity) {                                           \
+      size_t capacity = v->capacity == 0 ? 8 : v->capacity * 2;               \
+      T *items = realloc(v->items, capacity * sizeof(T));                     \
+                                                                              \
+      if (items == NULL) {                                                    \
+        return 0;                                                             \
+      }                                                                       \
+                                                                              \
+      v->items = items;                                                       \
+      v->capacity = capacity;                                                 \
+    }                                                                         \
+                                                                              \
+    v->items[v->length++] = value;                                            \
+                                                                              \
+    return 1;                                                                 \
+  }                                                                           \
+                                                                              \
+  /* Returns the index of `value`, or -1 if it isn't in the array */          \
+  static inline long name##_index_of(T value, name *v) {                      \
+    for (size_t i = 0; i < v->length; i++) {                                  \
+      if (equals(v->items[i], value)) {                                       \
+        return (long) i;                                                      \
+      }                                                                       \
+    }                                                                         \
+                                                                              \
+    return -1;                                                                \
+  }                                                                           \
+                                                                              \
+  static inline void name##_free(name *v) {                                   \
+    free(v->items);                                                           \
+                                                                              \
+    v->items = NULL;                                                          \
+    v->length = 0;                                                            \
+    v->capacity = 0;                                                          \
+  }
+
+/* A binary search tree ordered by the `compare` hook. Inserting a value that
+ * compares equal to one that's already in the tree replaces it.
+ */
+#define DEFINE_TREE(T, name, compare)                                         \
+  typedef struct name##_node {                                                \
+    T value;                                                                  \
+    struct name##_node *left;                                                 \
+    struct name##_node *right;                                                \
+  } name##_node;                                                              \
+                                                                              \
+  static inline void name##_insert(T value, name##_node **root) {             \
+    while (*root != NULL) {                                                   \
+      int order = compare(value, (*root)->value);                             \
+                                                                              \
+      if (order == 0) {                                                       \
+        (*root)->value = value;                                               \
+        return;                                                               \
+      }                                                                       \
+                                                                              \
+      root = order < 0 ? &(*root)->left : &(*root)->right;                    \
+    }                                                                         \
+                                                                              \
+    name##_node *n = malloc(sizeof(name##_node));                             \
+                                                                              \
+    n->value = value;                                                         \
+    n->left = NULL;                                                           \
+    n->right = NULL;                                                          \
+                                                                              \
+    *root = n;                                                                \
+  }                                                                           \
+                                                                              \
+  static inline name##_node* name##_find(T value, name##_node *root) {        \
+    while (root != NULL) {                                                    \
+      int order = compare(value, root->value);                                \
+                                                                              \
+      if (order == 0) {                                                       \
+        break;                                                                \
+      }                                                                       \
+                                                                              \
+      root = order < 0 ? root->left : root->right;                            \
+    }                                                                         \
+                                                                              \
+    return root;                                                              \
+  }                                                                           \
+                                                                              \
+  static inline void name##_free(name##_node *root) {                         \
+    if (root == NULL) {                                                       \
+      return;                                                                 \
+    }                                                                         \
+                                                                              \
+    name##_free(root->left);                                                  \
+    name##_free(root->right);                                                 \
+                                                                              \
+    free(root);                                                               \
+  }
+
+/* The hooks for plain `int`s can be simple macros. `compare` avoids `a - b`
+ * because that can overflow for values far apart.
+ */
+#define INT_EQUALS(a, b) ((a) == (b))
+#define INT_COMPARE(a, b) (((a) > (b)) - ((a) < (b)))
+
+/* A 24 byte record, which is stored inline in each node rather than behind a
+ * pointer. Its hooks only look at `id`.
+ */
+typedef struct {
+  long id;
+  double score;
+  int flags;
+} record;
+
+static inline int record_equals(record a, record b) {
+  return a.id == b.id;
+}
+
+static inline int record_compare(record a, record b) {
+  return INT_COMPARE(a.id, b.id);
+}
+
+DEFINE_LIST(int, int_list, INT_EQUALS)
+DEFINE_QUEUE(record, record_queue)
+DEFINE_VECTOR(int, int_vector, INT_EQUALS)
+DEFINE_TREE(record, record_tree, record_compare)
+
+// The tree can even be put in a list, which is what the breadth-first search needs
+DEFINE_QUEUE(record_tree_node *, tree_queue)
+
+int main() {
+  int_list_node *list = NULL;
+
+  int_list_append(2, &list);
+  int_list_append(3, &list);
+  int_list_prepend(1, &list);
+
+  for (int_list_node *current = list; current != NULL; current = current->next) {
+    printf("%p = %d\n", (void *) current, current->value);
+  }
+
+  printf("Found 3 at %p\n", (void *) int_list_find(3, list));
+
+  int_list_free(&list);
+
+  printf("\n----------------\n\n");
+
+  int_vector v = {NULL, 0, 0};
+
+  for (int i = 0; i < 20; i++) {
+    int_vector_push(i * i, &v);
+  }
+
+  printf("%zu ints in a vector with room for %zu, 49 is at index %ld\n", v.length, v.capacity, int_vector_index_of(49, &v));
+
+  int_vector_free(&v);
+
+  printf("\n----------------\n\n");
+
+  record_queue q = {NULL, NULL};
+  record_tree_node *tree = NULL;
+
+  record_queue_push((record) {4, 0.5, 0}, &q);
+  record_queue_push((record) {2, 1.5, 0}, &q);
+  record_queue_push((record) {6, 2.5, 1}, &q);
+  record_queue_push((record) {1, 3.5, 1}, &q);
+
+  while (!record_queue_is_empty(&q)) {
+    record_tree_insert(record_queue_shift(&q), &tree);
+  }
+
+  printf("sizeof(record) = %zu, sizeof(record_tree_node) = %zu\n", sizeof(record), sizeof(record_tree_node));
+  printf("Record 6 has a score of %.1f\n", record_tree_find((record) {6, 0, 0}, tree)->value.score);
+
+  printf("Breadth-first traversal: ");
+
+  tree_queue bfs = {NULL, NULL};
+  tree_queue_push(tree, &bfs);
+
+  while (!tree_queue_is_empty(&bfs)) {
+    record_tree_node *current = tree_queue_shift(&bfs);
+
+    printf("%ld ", current->value.id);
+
+    if (current->left != NULL) {
+      tree_queue_push(current->left, &bfs);
+    }
+
+    if (current->right != NULL) {
+      tree_queue_push(current->right, &bfs);
+    }
+  }
+
+  printf("\n");
+
+  record_tree_free(tree);
+
+  return 0;
+}
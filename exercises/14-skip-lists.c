@@ -0,0 +1,330 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+/* `remove_at()` in `./10-linked-lists.c` has to walk `i` nodes to reach index `i`,
+ * because each node only knows about the one right after it. A **skip list** gives
+ * some of the nodes extra pointers that jump further ahead:
+ *
+ *   level 2:  head ------------------------> 5 ---------------> NULL
+ *   level 1:  head --------> 2 ------------> 5 ------> 7 -----> NULL
+ *   level 0:  head -> 1 ---> 2 ---> 3 ---> 4 -> 5 ---> 6 -> 7 -> NULL
+ *
+ * Every node is on level 0, which is just an ordinary linked list. When a node is
+ * created it's also put on level 1 with a probability of 1/4, on level 2 with a
+ * probability of 1/16, and so on. To find something we start on the top level and
+ * move right for as long as we don't overshoot, then drop down a level and repeat.
+ * On average that's O(log n) steps.
+ *
+ * To find a node by its *position* rather than its value, each link also records
+ * its **span**: how many positions it moves forward. Above, the level 2 link from
+ * `head` to `5` has a span of 5, and the level 1 link from `2` to `5` has a span
+ * of 3. Adding up the spans of the links we follow tells us the position we're at,
+ * so we know when to drop down a level. If a link points to NULL its span isn't
+ * used.
+ *
+ * The links are stored in a flexible array member at the end of the node, so a
+ * node and all of its levels are allocated in a single block with one `malloc()`.
+ */
+#define MAX_LEVEL 32
+
+typedef struct skip_link {
+  struct skip_node *next;
+  int span;
+} skip_link;
+
+typedef struct skip_node {
+  int value;
+  int level;
+  skip_link links[];
+} skip_node;
+
+/* `head` is a node without a value that has a link on every level. It counts as
+ * position 0, so the element at index `i` is at position `i + 1`.
+ */
+typedef struct {
+  skip_node *head;
+  int level;
+  int length;
+} skip_list;
+
+skip_node* getSkipNode(int value, int level) {
+  skip_node *n = malloc(sizeof(skip_node) + level * sizeof(skip_link));
+
+  n->value = value;
+  n->level = level;
+
+  for (int i = 0; i < level; i++) {
+    n->links[i].next = NULL;
+    n->links[i].span = 0;
+  }
+
+  return n;
+}
+
+skip_list* skip_list_new() {
+  skip_list *list = malloc(sizeof(skip_list));
+
+  list->head = getSkipNode(0, MAX_LEVEL);
+  list->level = 1;
+  list->length = 0;
+
+  return list;
+}
+
+int random_level() {
+  int level = 1;
+
+  while (level < MAX_LEVEL && (rand() & 3) == 0) {
+    level++;
+  }
+
+  return level;
+}
+
+/* Fills `update` with the last node before position `i + 1` on each level, and
+ * `rank` with the position of each of those nodes. These are the nodes whose links
+ * will need to change when a node is added or removed at index `i`.
+ */
+void find_index(int i, skip_list *list, skip_node **update, int *rank) {
+  skip_node *current = list->head;
+  int position = 0;
+
+  for (int l = list->level - 1; l >= 0; l--) {
+    while (current->links[l].next != NULL && position + current->links[l].span <= i) {
+      position += current->links[l].span;
+      current = current->links[l].next;
+    }
+
+    update[l] = current;
+    rank[l] = position;
+  }
+}
+
+/* Like `find_index()`, except it stops before the first node with a value that
+ * isn't less than `value`
+ */
+void find_value(int value, skip_list *list, skip_node **update, int *rank) {
+  skip_node *current = list->head;
+  int position = 0;
+
+  for (int l = list->level - 1; l >= 0; l--) {
+    while (current->links[l].next != NULL && current->links[l].next->value < value) {
+      position += current->links[l].span;
+      current = current->links[l].next;
+    }
+
+    update[l] = current;
+    rank[l] = position;
+  }
+}
+
+/* Links a new node in at position `rank[0] + 1`. On each of the new node's levels,
+ * the link that used to jump over this position is split in two; on the levels
+ * above it, that link now jumps over one more position.
+ */
+void link_node(int value, skip_list *list, skip_node **update, int *rank) {
+  int level = random_level();
+
+  if (level > list->level) {
+    for (int l = list->level; l < level; l++) {
+      update[l] = list->head;
+      rank[l] = 0;
+    }
+
+    list->level = level;
+  }
+
+  skip_node *n = getSkipNode(value, level);
+
+  for (int l = 0; l < level; l++) {
+    skip_link *before = &update[l]->links[l];
+    int distance = rank[0] - rank[l];
+
+    n->links[l].next = before->next;
+    n->links[l].span = before->next != NULL ? before->span - distance : 0;
+
+    before->next = n;
+    before->span = distance + 1;
+  }
+
+  for (int l = level; l < list->level; l++) {
+    if (update[l]->links[l].next != NULL) {
+      update[l]->links[l].span++;
+    }
+  }
+
+  list->length++;
+}
+
+/* Inserts `value` so that it ends up at index `i`. Does nothing if `i` is past
+ * the end of the list.
+ */
+void insert_at(int i, int value, skip_list *list) {
+  skip_node *update[MAX_LEVEL];
+  int rank[MAX_LEVEL];
+
+  if (i < 0 || i > list->length) {
+    return;
+  }
+
+  find_index(i, list, update, rank);
+  link_node(value, list, update, rank);
+}
+
+// Inserts `value` before the first value that isn't less than it
+void insert_sorted(int value, skip_list *list) {
+  skip_node *update[MAX_LEVEL];
+  int rank[MAX_LEVEL];
+
+  find_value(value, list, update, rank);
+  link_node(value, list, update, rank);
+}
+
+void append(int value, skip_list *list) {
+  insert_at(list->length, value, list);
+}
+
+void prepend(int value, skip_list *list) {
+  insert_at(0, value, list);
+}
+
+/* Returns the node at index `i`, or NULL if there isn't one
+ */
+skip_node* get_at(int i, skip_list *list) {
+  if (i < 0 || i >= list->length) {
+    return NULL;
+  }
+
+  skip_node *current = list->head;
+  int position = 0;
+
+  for (int l = list->level - 1; l >= 0; l--) {
+    while (current->links[l].next != NULL && position + current->links[l].span <= i + 1) {
+      position += current->links[l].span;
+      current = current->links[l].next;
+    }
+
+    if (position == i + 1) {
+      break;
+    }
+  }
+
+  return current;
+}
+
+/* Removes the node at index `i`. On each of its levels, the link pointing to it
+ * is replaced by the node's own link, which now covers both spans minus the
+ * position being removed. Links above it just jump over one less position.
+ */
+void remove_at(int i, skip_list *list) {
+  skip_node *update[MAX_LEVEL];
+  int rank[MAX_LEVEL];
+
+  if (i < 0 || i >= list->length) {
+    return;
+  }
+
+  find_index(i, list, update, rank);
+
+  skip_node *subject = update[0]->links[0].next;
+
+  for (int l = 0; l < list->level; l++) {
+    skip_link *before = &update[l]->links[l];
+
+    if (before->next == subject) {
+      before->span += subject->links[l].span - 1;
+      before->next = subject->links[l].next;
+    } else if (before->next != NULL) {
+      before->span--;
+    }
+  }
+
+  while (list->level > 1 && list->head->links[list->level - 1].next == NULL) {
+    list->level--;
+  }
+
+  list->length--;
+
+  free(subject);
+}
+
+void remove_first(skip_list *list) {
+  remove_at(0, list);
+}
+
+void remove_last(skip_list *list) {
+  remove_at(list->length - 1, list);
+}
+
+void skip_list_free(skip_list *list) {
+  skip_node *current = list->head;
+
+  while (current != NULL) {
+    skip_node *next = current->links[0].next;
+
+    free(current);
+
+    current = next;
+  }
+
+  free(list);
+}
+
+void print_list(skip_list *list) {
+  for (skip_node *current = list->head->links[0].next; current != NULL; current = current->links[0].next) {
+    printf("%d ", current->value);
+  }
+
+  printf("(length = %d, levels = %d)\n", list->length, list->level);
+}
+
+int main() {
+  skip_list *list = skip_list_new();
+
+  append(2, list);
+  append(3, list);
+  prepend(0, list);
+  insert_at(1, 1, list);
+  print_list(list);
+
+  remove_first(list);
+  remove_at(1, list);
+  print_list(list);
+
+  remove_last(list);
+  remove_first(list);
+  print_list(list);
+
+  for (int i = 10; i > 0; i--) {
+    insert_sorted(i * 3 % 11, list);
+  }
+
+  print_list(list);
+  printf("get_at(4) = %d\n", get_at(4, list)->value);
+
+  skip_list_free(list);
+
+  printf("\n----------------\n\n");
+
+  /* Editing the middle of a long list is where this pays off: each of these would
+   * have to walk half a million nodes with the list in `./10-linked-lists.c`
+   */
+  list = skip_list_new();
+
+  for (int i = 0; i < 1000000; i++) {
+    append(i, list);
+  }
+
+  for (int i = 0; i < 1000; i++) {
+    remove_at(500000, list);
+    insert_at(500000, -i, list);
+  }
+
+  printf("get_at(499999) = %d\n", get_at(499999, list)->value);
+  printf("get_at(500000) = %d\n", get_at(500000, list)->value);
+  printf("get_at(500001) = %d\n", get_at(500001, list)->value);
+
+  skip_list_free(list);
+
+  return 0;
+}
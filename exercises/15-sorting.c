@@ -0,0 +1,489 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+
+/* The dynamic arrays in `./09-dynamic-arrays.c` are just blocks of `int`s, and the
+ * standard library's answer to sorting one is `qsort()`. It works on any type, but
+ * that's also why it's slow: it only knows the size of each element, so it has to
+ * call a comparison function through a pointer for every single comparison.
+ *
+ * When we know the elements are `int`s we can do a lot better. This exercise has a
+ * few different ways of sorting them, and a benchmark that compares them to
+ * `qsort()`. (This needs to be compiled with `-pthread`, and with `-msse4.1` or
+ * `-march=native` to use the SIMD version of the small sort.)
+ *
+ * Usage: `./15-sorting [number of elements] [number of threads]`
+ */
+
+/* **LSD radix sort** doesn't compare elements at all. It looks at one byte of each
+ * value at a time, starting with the least significant, and does a stable counting
+ * sort on that byte: count how many values have each of the 256 possible bytes,
+ * use the counts to work out where each group starts, then copy every value into
+ * its group. After four passes (one per byte) the whole array is sorted, so this
+ * is O(n) rather than O(n log n).
+ *
+ * Each pass copies from one buffer into another, so it needs a scratch buffer the
+ * same size as the array. It's passed in rather than allocated here so that it can
+ * be reused across calls.
+ *
+ * The values are read as `unsigned` with the top bit flipped. That turns the most
+ * negative `int` into 0 and the most positive into the largest `unsigned`, so the
+ * bytes sort negative numbers before positive ones.
+ */
+void radix_sort(int *values, size_t length, int *scratch) {
+  unsigned *source = (unsigned *) values;
+  unsigned *destination = (unsigned *) scratch;
+
+  for (int shift = 0; shift < 32; shift += 8) {
+    size_t counts[256] = {0};
+
+    for (size_t i = 0; i < length; i++) {
+      counts[((source[i] ^ 0x80000000u) >> shift) & 0xff]++;
+    }
+
+    // If every value has the same byte here, this pass wouldn't move anything
+    if (length == 0 || counts[((source[0] ^ 0x80000000u) >> shift) & 0xff] == length) {
+      continue;
+    }
+
+    size_t offset = 0;
+
+    for (int b = 0; b < 256; b++) {
+      size_t count = counts[b];
+      counts[b] = offset;
+      offset += count;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+      destination[counts[((source[i] ^ 0x80000000u) >> shift) & 0xff]++] = source[i];
+    }
+
+    unsigned *tmp = source;
+    source = destination;
+    destination = tmp;
+  }
+
+  if (source != (unsigned *) values) {
+    memcpy(values, source, length * sizeof(int));
+  }
+}
+
+void insertion_sort(int *values, size_t length) {
+  for (size_t i = 1; i < length; i++) {
+    int value = values[i];
+    size_t j = i;
+
+    while (j > 0 && values[j - 1] > value) {
+      values[j] = values[j - 1];
+      j--;
+    }
+
+    values[j] = value;
+  }
+}
+
+// Merges the sorted runs `a` and `b` into `destination`
+void merge(int *a, size_t a_length, int *b, size_t b_length, int *destination) {
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  while (i < a_length && j < b_length) {
+    destination[k++] = b[j] < a[i] ? b[j++] : a[i++];
+  }
+
+  while (i < a_length) {
+    destination[k++] = a[i++];
+  }
+
+  while (j < b_length) {
+    destination[k++] = b[j++];
+  }
+}
+
+#define BLOCK_LENGTH 16
+
+/* A **sorting network** is a fixed sequence of compare-and-swap steps that sorts
+ * any input of a certain size. Because the steps never depend on the data, they
+ * can be done without any branches, and with SIMD instructions several of them can
+ * be done at once.
+ *
+ * Here the 16 values are loaded into four registers of four `int`s each, like the
+ * rows of a 4x4 grid. `_mm_min_epi32()` and `_mm_max_epi32()` compare-and-swap two
+ * whole rows at a time, so running the five steps of a 4-input network on the rows
+ * sorts every *column* of the grid. Transposing the grid turns those columns into
+ * rows, which are stored back as four sorted runs of four, and then merged.
+ */
+#ifdef __SSE4_1__
+#define COMPARE_AND_SWAP(a, b) do { \
+    __m128i min = _mm_min_epi32(a, b); \
+    b = _mm_max_epi32(a, b); \
+    a = min; \
+  } while (0)
+
+void sort_block(int *values) {
+  __m128i a = _mm_loadu_si128((__m128i *) values);
+  __m128i b = _mm_loadu_si128((__m128i *) (values + 4));
+  __m128i c = _mm_loadu_si128((__m128i *) (values + 8));
+  __m128i d = _mm_loadu_si128((__m128i *) (values + 12));
+
+  COMPARE_AND_SWAP(a, b);
+  COMPARE_AND_SWAP(c, d);
+  COMPARE_AND_SWAP(a, c);
+  COMPARE_AND_SWAP(b, d);
+  COMPARE_AND_SWAP(b, c);
+
+  __m128i ab_low = _mm_unpacklo_epi32(a, b);
+  __m128i ab_high = _mm_unpackhi_epi32(a, b);
+  __m128i cd_low = _mm_unpacklo_epi32(c, d);
+  __m128i cd_high = _mm_unpackhi_epi32(c, d);
+
+  _mm_storeu_si128((__m128i *) values, _mm_unpacklo_epi64(ab_low, cd_low));
+  _mm_storeu_si128((__m128i *) (values + 4), _mm_unpackhi_epi64(ab_low, cd_low));
+  _mm_storeu_si128((__m128i *) (values + 8), _mm_unpacklo_epi64(ab_high, cd_high));
+  _mm_storeu_si128((__m128i *) (values + 12), _mm_unpackhi_epi64(ab_high, cd_high));
+
+  int runs[BLOCK_LENGTH];
+
+  merge(values, 4, values + 4, 4, runs);
+  merge(values + 8, 4, values + 12, 4, runs + 8);
+  merge(runs, 8, runs + 8, 8, values);
+}
+#else
+// Without SSE4.1 there's nothing to gain from the network, so fall back to this
+void sort_block(int *values) {
+  insertion_sort(values, BLOCK_LENGTH);
+}
+#endif
+
+/* A bottom-up merge sort that uses `sort_block()` for the first 16 values of
+ * every run. After that, each round merges pairs of runs into runs twice as long,
+ * copying back and forth between `values` and `scratch`.
+ */
+void merge_sort(int *values, size_t length, int *scratch) {
+  size_t i = 0;
+
+  for (; i + BLOCK_LENGTH <= length; i += BLOCK_LENGTH) {
+    sort_block(values + i);
+  }
+
+  insertion_sort(values + i, length - i);
+
+  int *source = values;
+  int *destination = scratch;
+
+  for (size_t width = BLOCK_LENGTH; width < length; width *= 2) {
+    for (size_t start = 0; start < length; start += 2 * width) {
+      size_t middle = start + width < length ? start + width : length;
+      size_t end = start + 2 * width < length ? start + 2 * width : length;
+
+      merge(source + start, middle - start, source + middle, end - middle, destination + start);
+    }
+
+    int *tmp = source;
+    source = destination;
+    destination = tmp;
+  }
+
+  if (source != values) {
+    memcpy(values, source, length * sizeof(int));
+  }
+}
+
+/* For large arrays we can split the work between threads. The array is divided
+ * into one chunk per thread and each chunk is radix sorted on its own. Then, like
+ * the rounds of `merge_sort()`, neighbouring chunks are merged in pairs (each pair
+ * on its own thread) until only one is left.
+ */
+typedef struct {
+  int *a;
+  size_t a_length;
+  int *b;
+  size_t b_length;
+  int *destination;
+} sort_job;
+
+void* radix_sort_job(void *arg) {
+  sort_job *job = arg;
+
+  radix_sort(job->a, job->a_length, job->destination);
+
+  return NULL;
+}
+
+void* merge_job(void *arg) {
+  sort_job *job = arg;
+
+  merge(job->a, job->a_length, job->b, job->b_length, job->destination);
+
+  return NULL;
+}
+
+// Runs `work` for each job, each on its own thread (or on this one, if it can't start one)
+void run_jobs(void* (*work)(void *), sort_job *jobs, int count) {
+  pthread_t *threads = malloc(count * sizeof(pthread_t));
+  int *started = malloc(count * sizeof(int));
+
+  for (int i = 0; i < count; i++) {
+    started[i] = pthread_create(&threads[i], NULL, work, &jobs[i]) == 0;
+
+    if (!started[i]) {
+      work(&jobs[i]);
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+  }
+
+  free(started);
+  free(threads);
+}
+
+void parallel_sort(int *values, size_t length, int *scratch, int thread_count) {
+  if (thread_count < 2 || length < (size_t) thread_count * 4096) {
+    radix_sort(values, length, scratch);
+    return;
+  }
+
+  size_t *bounds = malloc((thread_count + 1) * sizeof(size_t));
+  sort_job *jobs = malloc(thread_count * sizeof(sort_job));
+
+  for (int i = 0; i <= thread_count; i++) {
+    bounds[i] = length / thread_count * i + (i == thread_count ? length % thread_count : 0);
+  }
+
+  for (int i = 0; i < thread_count; i++) {
+    jobs[i] = (sort_job) {values + bounds[i], bounds[i + 1] - bounds[i], NULL, 0, scratch + bounds[i]};
+  }
+
+  run_jobs(radix_sort_job, jobs, thread_count);
+
+  int *source = values;
+  int *destination = scratch;
+  int chunks = thread_count;
+
+  while (chunks > 1) {
+    int pairs = 0;
+
+    for (int i = 0; i < chunks; i += 2) {
+      size_t start = bounds[i];
+      size_t middle = bounds[i + 1];
+      size_t end = i + 2 <= chunks ? bounds[i + 2] : middle;
+
+      jobs[pairs++] = (sort_job) {source + start, middle - start, source + middle, end - middle, destination + start};
+      bounds[i / 2] = start;
+    }
+
+    bounds[pairs] = length;
+    chunks = pairs;
+
+    run_jobs(merge_job, jobs, pairs);
+
+    int *tmp = source;
+    source = destination;
+    destination = tmp;
+  }
+
+  if (source != values) {
+    memcpy(values, source, length * sizeof(int));
+  }
+
+  free(jobs);
+  free(bounds);
+}
+
+/* Borrowed from `./10-linked-lists.c`. A linked list can't be radix sorted or
+ * split in half without walking it, but merge sort only ever reads runs from the
+ * front, which is exactly what lists are good at.
+ *
+ * This version works bottom-up, like `merge_sort()`: it merges runs of 1 node into
+ * runs of 2, then runs of 2 into runs of 4, and so on. Nodes are never copied or
+ * allocated, only relinked, so the only extra memory it needs is a few pointers.
+ */
+typedef struct node {
+  int value;
+  struct node *next;
+} node;
+
+// Detaches the first `length` nodes of `*head`, advancing `*head` past them
+node* split(node **head, size_t length) {
+  node *run = *head;
+  node **tail = head;
+
+  for (size_t i = 0; i < length && *tail != NULL; i++) {
+    tail = &(*tail)->next;
+  }
+
+  *head = *tail;
+  *tail = NULL;
+
+  return run;
+}
+
+void sort_list(node **head) {
+  for (size_t width = 1; ; width *= 2) {
+    node *rest = *head;
+    node **tail = head;
+    int merges = 0;
+
+    while (rest != NULL) {
+      node *a = split(&rest, width);
+      node *b = split(&rest, width);
+
+      while (a != NULL && b != NULL) {
+        node **smaller = b->value < a->value ? &b : &a;
+
+        *tail = *smaller;
+        tail = &(*smaller)->next;
+        *smaller = (*smaller)->next;
+      }
+
+      *tail = a != NULL ? a : b;
+
+      while (*tail != NULL) {
+        tail = &(*tail)->next;
+      }
+
+      merges++;
+    }
+
+    if (merges <= 1) {
+      return;
+    }
+  }
+}
+
+int compare_ints(const void *a, const void *b) {
+  int x = *(const int *) a;
+  int y = *(const int *) b;
+
+  return (x > y) - (x < y);
+}
+
+int is_sorted(int *values, size_t length) {
+  for (size_t i = 1; i < length; i++) {
+    if (values[i - 1] > values[i]) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+// `rand()` only promises 15 bits, so we stitch a few calls together
+unsigned random_bits() {
+  return ((unsigned) rand() << 30) ^ ((unsigned) rand() << 15) ^ (unsigned) rand();
+}
+
+/* Fills `values` with one of three kinds of input:
+ *
+ *  - **uniform:** any `int` is equally likely
+ *  - **sorted:** already in ascending order
+ *  - **skewed:** most values are small, with a long tail of large ones, and lots
+ *    of duplicates
+ */
+void fill(int *values, size_t length, const char *kind) {
+  for (size_t i = 0; i < length; i++) {
+    if (strcmp(kind, "uniform") == 0) {
+      values[i] = (int) random_bits();
+    } else if (strcmp(kind, "sorted") == 0) {
+      values[i] = (int) (i - length / 2);
+    } else {
+      values[i] = (int) (random_bits() >> (rand() % 32));
+    }
+  }
+}
+
+double seconds_since(struct timespec *start) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(int argc, char **argv) {
+  size_t length = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000000;
+  int thread_count = argc > 2 ? atoi(argv[2]) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+  node list[10];
+  node *head = &list[0];
+  int list_values[] = {5, 9, 1, 7, 3, 8, 2, 6, 0, 4};
+
+  for (int i = 0; i < 10; i++) {
+    list[i].value = list_values[i];
+    list[i].next = i < 9 ? &list[i + 1] : NULL;
+  }
+
+  sort_list(&head);
+
+  printf("Sorted list: ");
+
+  for (node *current = head; current != NULL; current = current->next) {
+    printf("%d ", current->value);
+  }
+
+  printf("\n\n");
+
+  int *original = malloc(length * sizeof(int));
+  int *values = malloc(length * sizeof(int));
+  int *scratch = malloc(length * sizeof(int));
+
+  if (original == NULL || values == NULL || scratch == NULL) {
+    printf("Couldn't allocate %zu ints\n", length);
+    return 1;
+  }
+
+  const char *kinds[] = {"uniform", "sorted", "skewed"};
+  const char *names[] = {"qsort", "radix", "merge (network)", "parallel"};
+
+  printf("Sorting %zu ints, %d threads\n\n", length, thread_count);
+  printf("%-10s", "input");
+
+  for (int s = 0; s < 4; s++) {
+    printf("%18s", names[s]);
+  }
+
+  printf("\n");
+
+  for (int k = 0; k < 3; k++) {
+    fill(original, length, kinds[k]);
+
+    printf("%-10s", kinds[k]);
+
+    for (int s = 0; s < 4; s++) {
+      memcpy(values, original, length * sizeof(int));
+
+      struct timespec start;
+      clock_gettime(CLOCK_MONOTONIC, &start);
+
+      switch (s) {
+        case 0: qsort(values, length, sizeof(int), compare_ints); break;
+        case 1: radix_sort(values, length, scratch); break;
+        case 2: merge_sort(values, length, scratch); break;
+        case 3: parallel_sort(values, length, scratch, thread_count); break;
+      }
+
+      double elapsed = seconds_since(&start);
+
+      printf("%16.3fs%s", elapsed, is_sorted(values, length) ? " " : "!");
+    }
+
+    printf("\n");
+  }
+
+  free(scratch);
+  free(values);
+  free(original);
+
+  return 0;
+}
@@ -0,0 +1,338 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* All of the other exercises build their data out of constants in `main()`. This
+ * one reads integers from a file (or stdin) and loads them into either the linked
+ * list from `./10-linked-lists.c` or the tree from `./11-binary-trees.c`.
+ *
+ * The obvious way to do that is a loop around `scanf("%d", &value)`, but that's
+ * slow for large inputs: every call has to parse the format string, lock the
+ * stream, and look up the current locale to decide what counts as a digit. Instead
+ * this reads the input in large blocks with `fread()` and parses the digits itself.
+ *
+ * Reading and parsing happen on one thread (the **producer**) while building the
+ * list or tree happens on another (the **consumer**), so the two can overlap. The
+ * producer hands values over in batches through a queue with a fixed number of
+ * slots. If the consumer falls behind the queue fills up and the producer has to
+ * wait for a free slot; this is known as **backpressure**, and it keeps the
+ * producer from reading the whole file into memory ahead of the consumer. (This
+ * needs to be compiled with `-pthread`.)
+ *
+ * Usage: `./16-streaming-input list|tree [file]`, e.g.
+ * `seq 1 10000000 | ./16-streaming-input tree`
+ */
+#define READ_BLOCK_SIZE (1 << 20)
+#define BATCH_LENGTH 4096
+#define QUEUE_SLOTS 16
+
+typedef struct {
+  int values[BATCH_LENGTH];
+  int length;
+} batch;
+
+/* The queue is a ring of batches. The producer only ever fills the slot at `tail`
+ * and the consumer only ever reads the slot at `head`, and `count` keeps them from
+ * passing each other, so a slot is never used by both threads at the same time.
+ * The lock is only held while moving `head`, `tail` and `count`, not while a batch
+ * is being filled or read.
+ */
+typedef struct {
+  batch slots[QUEUE_SLOTS];
+  int head;
+  int tail;
+  int count;
+  int done;
+  long stalls;
+  pthread_mutex_t lock;
+  pthread_cond_t not_full;
+  pthread_cond_t not_empty;
+} batch_queue;
+
+// Waits for a free slot and returns it for the producer to fill
+batch* acquire_empty(batch_queue *q) {
+  pthread_mutex_lock(&q->lock);
+
+  if (q->count == QUEUE_SLOTS) {
+    q->stalls++;
+  }
+
+  while (q->count == QUEUE_SLOTS) {
+    pthread_cond_wait(&q->not_full, &q->lock);
+  }
+
+  batch *b = &q->slots[q->tail];
+
+  pthread_mutex_unlock(&q->lock);
+
+  b->length = 0;
+
+  return b;
+}
+
+// Hands the slot returned by `acquire_empty()` over to the consumer
+void publish(batch_queue *q) {
+  pthread_mutex_lock(&q->lock);
+
+  q->tail = (q->tail + 1) % QUEUE_SLOTS;
+  q->count++;
+
+  pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+}
+
+// Lets the consumer know there won't be any more batches
+void finish(batch_queue *q) {
+  pthread_mutex_lock(&q->lock);
+
+  q->done = 1;
+
+  pthread_cond_signal(&q->not_empty);
+  pthread_mutex_unlock(&q->lock);
+}
+
+// Waits for a full slot, or returns NULL once the producer has finished
+batch* acquire_full(batch_queue *q) {
+  pthread_mutex_lock(&q->lock);
+
+  while (q->count == 0 && !q->done) {
+    pthread_cond_wait(&q->not_empty, &q->lock);
+  }
+
+  batch *b = q->count > 0 ? &q->slots[q->head] : NULL;
+
+  pthread_mutex_unlock(&q->lock);
+
+  return b;
+}
+
+// Gives the slot returned by `acquire_full()` back to the producer
+void release(batch_queue *q) {
+  pthread_mutex_lock(&q->lock);
+
+  q->head = (q->head + 1) % QUEUE_SLOTS;
+  q->count--;
+
+  pthread_cond_signal(&q->not_full);
+  pthread_mutex_unlock(&q->lock);
+}
+
+/* A number can be cut in half by the end of a block, so the parser keeps track of
+ * the one it's in the middle of between calls to `parse_block()`.
+ *
+ * Only ASCII digits and a leading `-` are part of a number; anything else (spaces,
+ * newlines, commas) separates them. Values that don't fit in an `int` wrap around.
+ */
+typedef struct {
+  int in_number;
+  int negative;
+  unsigned value;
+} parser;
+
+void parse_block(parser *p, const char *block, size_t length, batch_queue *q, batch **current) {
+  for (size_t i = 0; i < length; i++) {
+    unsigned digit = (unsigned char) block[i] - '0';
+
+    if (digit < 10) {
+      p->value = p->value * 10 + digit;
+      p->in_number = 1;
+      continue;
+    }
+
+    if (p->in_number) {
+      (*current)->values[(*current)->length++] = (int) (p->negative ? 0u - p->value : p->value);
+
+      if ((*current)->length == BATCH_LENGTH) {
+        publish(q);
+        *current = acquire_empty(q);
+      }
+    }
+
+    p->in_number = 0;
+    p->negative = block[i] == '-';
+    p->value = 0;
+  }
+}
+
+/* Borrowed from `./10-linked-lists.c`. To make each append O(1), the consumer
+ * keeps a pointer to the last node instead of walking from the head every time.
+ */
+typedef struct list_node {
+  int value;
+  struct list_node *next;
+} list_node;
+
+/* Borrowed from `./11-binary-trees.c`. Inserting values one at a time would give a
+ * badly unbalanced tree for input that's already sorted (which integer dumps often
+ * are), so the consumer collects the values into an array instead, and once the
+ * input ends it sorts them and uses `buildBalancedTree()`.
+ */
+typedef struct tree_node {
+  int value;
+  struct tree_node *left;
+  struct tree_node *right;
+} tree_node;
+
+tree_node* buildBalancedSubtree(int *values, tree_node *slot, long length) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  long left_length = (length - 1) / 2;
+
+  slot->value = values[left_length];
+  slot->left = buildBalancedSubtree(values, slot + 1, left_length);
+  slot->right = buildBalancedSubtree(values + left_length + 1, slot + 1 + left_length, length - left_length - 1);
+
+  return slot;
+}
+
+tree_node* buildBalancedTree(int *values, long length) {
+  if (length <= 0) {
+    return NULL;
+  }
+
+  tree_node *nodes = malloc(length * sizeof(tree_node));
+
+  return buildBalancedSubtree(values, nodes, length);
+}
+
+int compare_ints(const void *a, const void *b) {
+  int x = *(const int *) a;
+  int y = *(const int *) b;
+
+  return (x > y) - (x < y);
+}
+
+typedef struct {
+  batch_queue *queue;
+  int build_tree;
+  long count;
+  list_node *head;
+  tree_node *root;
+} consumer;
+
+void* consume(void *arg) {
+  consumer *c = arg;
+  list_node **tail = &c->head;
+  int *values = NULL;
+  long capacity = 0;
+  batch *b;
+
+  while ((b = acquire_full(c->queue)) != NULL) {
+    if (c->build_tree) {
+      while (c->count + b->length > capacity) {
+        capacity = capacity == 0 ? BATCH_LENGTH : capacity * 2;
+        values = realloc(values, capacity * sizeof(int));
+      }
+
+      memcpy(values + c->count, b->values, b->length * sizeof(int));
+    } else {
+      for (int i = 0; i < b->length; i++) {
+        list_node *n = malloc(sizeof(list_node));
+
+        n->value = b->values[i];
+        n->next = NULL;
+
+        *tail = n;
+        tail = &n->next;
+      }
+    }
+
+    c->count += b->length;
+
+    release(c->queue);
+  }
+
+  if (c->build_tree) {
+    qsort(values, c->count, sizeof(int), compare_ints);
+    c->root = buildBalancedTree(values, c->count);
+    free(values);
+  }
+
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2 || (strcmp(argv[1], "list") != 0 && strcmp(argv[1], "tree") != 0)) {
+    printf("Usage: %s list|tree [file]\n", argv[0]);
+    return 1;
+  }
+
+  FILE *input = argc > 2 ? fopen(argv[2], "rb") : stdin;
+
+  if (input == NULL) {
+    printf("Couldn't open %s\n", argv[2]);
+    return 1;
+  }
+
+  batch_queue *q = calloc(1, sizeof(batch_queue));
+
+  pthread_mutex_init(&q->lock, NULL);
+  pthread_cond_init(&q->not_full, NULL);
+  pthread_cond_init(&q->not_empty, NULL);
+
+  consumer c = {q, strcmp(argv[1], "tree") == 0, 0, NULL, NULL};
+  pthread_t consumer_thread;
+
+  if (pthread_create(&consumer_thread, NULL, consume, &c) != 0) {
+    printf("Couldn't start the consumer thread\n");
+    return 1;
+  }
+
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  char *block = malloc(READ_BLOCK_SIZE);
+  parser p = {0, 0, 0};
+  batch *current = acquire_empty(q);
+  size_t bytes = 0;
+  size_t length;
+
+  while ((length = fread(block, 1, READ_BLOCK_SIZE, input)) > 0) {
+    parse_block(&p, block, length, q, &current);
+    bytes += length;
+  }
+
+  // A single separator flushes out a number that runs right up to the end of the input
+  parse_block(&p, "\n", 1, q, &current);
+  publish(q);
+  finish(q);
+
+  pthread_join(consumer_thread, NULL);
+
+  struct timespec end;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  printf("Loaded %ld values into a %s\n", c.count, c.build_tree ? "tree" : "list");
+  printf("%zu bytes in %.3fs (%.1f MB/s, %.1f million values/s)\n",
+    bytes, seconds, bytes / seconds / 1e6, c.count / seconds / 1e6);
+  printf("The reader waited on a full queue %ld times\n", q->stalls);
+
+  if (c.build_tree) {
+    if (c.root != NULL) {
+      printf("Root value: %d\n", c.root->value);
+    }
+
+    free(c.root);
+  } else {
+    while (c.head != NULL) {
+      list_node *next = c.head->next;
+      free(c.head);
+      c.head = next;
+    }
+  }
+
+  if (input != stdin) {
+    fclose(input);
+  }
+
+  free(block);
+  free(q);
+
+  return 0;
+}
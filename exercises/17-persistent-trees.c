@@ -0,0 +1,360 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* None of the trees in `./11-binary-trees.c` can be read by one thread while another
+ * thread changes them: a reader could follow a pointer to a node right as it's being
+ * freed. The usual fix is a lock around the whole tree, but then readers have to
+ * wait for each other (or at least for the lock itself), which limits how many
+ * lookups can happen at once.
+ *
+ * A **persistent** tree avoids this by never changing a node once other threads can
+ * see it. To insert or remove a value, the writer copies only the nodes on the path
+ * from the root down to where the change happens. The copies point to the same
+ * subtrees as the originals everywhere else, so they share most of the tree:
+ *
+ *   before:      4              after inserting 6:      4'
+ *               / \                                    / \
+ *              2   5                                  2   5'
+ *                                                          \
+ *                                                           6
+ *
+ * Only `4'` and `5'` are new, and `2` belongs to both versions. Once the new version
+ * is ready, publishing it is a single atomic store of the root pointer. A reader
+ * loads the root once and from then on sees a **snapshot** that will never change
+ * under it, without taking any locks.
+ *
+ * The old path (`4` and `5` above) can't be freed straight away, though, because a
+ * reader might still be looking at the old version. This is handled with
+ * **epoch-based reclamation**:
+ *
+ *  - There's a global epoch number that the writer increases after each update.
+ *  - A reader writes the current epoch into its own slot before it loads the root,
+ *    and clears its slot when it's done with the snapshot.
+ *  - When the writer replaces nodes, it records the epoch they were retired in.
+ *  - A retired node can be freed once every reader that's still busy started in a
+ *    *later* epoch. Those readers loaded the root after the new version was
+ *    published, so none of them can reach the old nodes.
+ *
+ * Writers still take turns with a lock, and the tree isn't rebalanced. (This needs
+ * to be compiled with `-pthread`.)
+ */
+#define MAX_READERS 64
+#define IDLE 0
+
+typedef struct node {
+  int value;
+  struct node *left;
+  struct node *right;
+} node;
+
+typedef struct retired_node {
+  node *n;
+  unsigned long epoch;
+  struct retired_node *next;
+} retired_node;
+
+typedef struct {
+  _Atomic(node *) root;
+  atomic_ulong epoch;
+  atomic_ulong reader_epochs[MAX_READERS];
+  pthread_mutex_t write_lock;
+  retired_node *retired;
+} persistent_tree;
+
+persistent_tree* persistent_tree_new() {
+  persistent_tree *t = malloc(sizeof(persistent_tree));
+
+  atomic_init(&t->root, NULL);
+  // Epochs start at 1 so that 0 can mean a reader slot isn't in use
+  atomic_init(&t->epoch, 1);
+
+  for (int i = 0; i < MAX_READERS; i++) {
+    atomic_init(&t->reader_epochs[i], IDLE);
+  }
+
+  pthread_mutex_init(&t->write_lock, NULL);
+  t->retired = NULL;
+
+  return t;
+}
+
+/* Returns a snapshot of the tree for the reader with the given slot. Each reader
+ * thread needs its own slot, and has to call `read_end()` once it's finished with
+ * the snapshot.
+ */
+node* read_begin(persistent_tree *t, int reader) {
+  atomic_store(&t->reader_epochs[reader], atomic_load(&t->epoch));
+
+  return atomic_load(&t->root);
+}
+
+void read_end(persistent_tree *t, int reader) {
+  atomic_store(&t->reader_epochs[reader], IDLE);
+}
+
+int contains(int value, node *x) {
+  while (x != NULL && x->value != value) {
+    x = value < x->value ? x->left : x->right;
+  }
+
+  return x != NULL;
+}
+
+node* getNode(int value, node *left, node *right) {
+  node *n = malloc(sizeof(node));
+
+  n->value = value;
+  n->left = left;
+  n->right = right;
+
+  return n;
+}
+
+// Adds `x` to the writer's list of nodes that are no longer part of the newest version
+void retire(node *x, retired_node **retired) {
+  retired_node *r = malloc(sizeof(retired_node));
+
+  r->n = x;
+  r->epoch = 0;
+  r->next = *retired;
+
+  *retired = r;
+}
+
+/* Each of these returns the root of a new version of the subtree `x`. Every node
+ * they pass through is copied and the original is retired.
+ */
+node* copyInsert(int value, node *x, retired_node **retired) {
+  if (x == NULL) {
+    return getNode(value, NULL, NULL);
+  }
+
+  retire(x, retired);
+
+  if (value < x->value) {
+    return getNode(x->value, copyInsert(value, x->left, retired), x->right);
+  }
+
+  return getNode(x->value, x->left, copyInsert(value, x->right, retired));
+}
+
+node* copyRemoveSmallest(node *x, int *smallest, retired_node **retired) {
+  retire(x, retired);
+
+  if (x->left == NULL) {
+    *smallest = x->value;
+
+    return x->right;
+  }
+
+  return getNode(x->value, copyRemoveSmallest(x->left, smallest, retired), x->right);
+}
+
+node* copyRemove(int value, node *x, retired_node **retired) {
+  retire(x, retired);
+
+  if (value < x->value) {
+    return getNode(x->value, copyRemove(value, x->left, retired), x->right);
+  }
+
+  if (value > x->value) {
+    return getNode(x->value, x->left, copyRemove(value, x->right, retired));
+  }
+
+  if (x->left == NULL) {
+    return x->right;
+  }
+
+  if (x->right == NULL) {
+    return x->left;
+  }
+
+  // Replace this node with a copy of the smallest value from its right subtree
+  int smallest;
+  node *right = copyRemoveSmallest(x->right, &smallest, retired);
+
+  return getNode(smallest, x->left, right);
+}
+
+/* Frees every retired node whose epoch is older than the oldest epoch any reader
+ * is still using.
+ */
+void reclaim(persistent_tree *t) {
+  unsigned long oldest = atomic_load(&t->epoch);
+
+  for (int i = 0; i < MAX_READERS; i++) {
+    unsigned long epoch = atomic_load(&t->reader_epochs[i]);
+
+    if (epoch != IDLE && epoch < oldest) {
+      oldest = epoch;
+    }
+  }
+
+  retired_node **current = &t->retired;
+
+  while (*current != NULL) {
+    retired_node *r = *current;
+
+    if (r->epoch < oldest) {
+      *current = r->next;
+
+      free(r->n);
+      free(r);
+    } else {
+      current = &r->next;
+    }
+  }
+}
+
+/* Publishes the new root, tags the nodes the update replaced with the current
+ * epoch, and moves on to the next epoch.
+ */
+void publish(persistent_tree *t, node *root, retired_node *retired) {
+  atomic_store(&t->root, root);
+
+  unsigned long epoch = atomic_load(&t->epoch);
+
+  while (retired != NULL) {
+    retired_node *next = retired->next;
+
+    retired->epoch = epoch;
+    retired->next = t->retired;
+    t->retired = retired;
+
+    retired = next;
+  }
+
+  atomic_store(&t->epoch, epoch + 1);
+
+  reclaim(t);
+}
+
+void insert(int value, persistent_tree *t) {
+  pthread_mutex_lock(&t->write_lock);
+
+  node *root = atomic_load(&t->root);
+
+  if (!contains(value, root)) {
+    retired_node *retired = NULL;
+    node *new_root = copyInsert(value, root, &retired);
+
+    publish(t, new_root, retired);
+  }
+
+  pthread_mutex_unlock(&t->write_lock);
+}
+
+void remove_value(int value, persistent_tree *t) {
+  pthread_mutex_lock(&t->write_lock);
+
+  node *root = atomic_load(&t->root);
+
+  if (contains(value, root)) {
+    retired_node *retired = NULL;
+    node *new_root = copyRemove(value, root, &retired);
+
+    publish(t, new_root, retired);
+  }
+
+  pthread_mutex_unlock(&t->write_lock);
+}
+
+// Only safe once no other threads are using the tree
+void freeTreeMemory(node *root) {
+  if (root == NULL) {
+    return;
+  }
+
+  freeTreeMemory(root->left);
+  freeTreeMemory(root->right);
+
+  free(root);
+}
+
+void persistent_tree_free(persistent_tree *t) {
+  reclaim(t);
+  freeTreeMemory(atomic_load(&t->root));
+  pthread_mutex_destroy(&t->write_lock);
+  free(t);
+}
+
+#define READER_COUNT 4
+#define KEY_RANGE 1024
+
+typedef struct {
+  persistent_tree *tree;
+  int slot;
+  atomic_int *stop;
+  long lookups;
+  long hits;
+} reader_job;
+
+void* reader(void *arg) {
+  reader_job *job = arg;
+  unsigned seed = job->slot;
+
+  while (!atomic_load(job->stop)) {
+    node *snapshot = read_begin(job->tree, job->slot);
+
+    for (int i = 0; i < 64; i++) {
+      job->hits += contains(rand_r(&seed) % KEY_RANGE, snapshot);
+      job->lookups++;
+    }
+
+    read_end(job->tree, job->slot);
+  }
+
+  return NULL;
+}
+
+int main() {
+  persistent_tree *tree = persistent_tree_new();
+
+  for (int i = 0; i < KEY_RANGE; i += 2) {
+    insert((i * 37) % KEY_RANGE, tree);
+  }
+
+  atomic_int stop;
+  atomic_init(&stop, 0);
+
+  pthread_t threads[READER_COUNT];
+  reader_job jobs[READER_COUNT];
+
+  for (int i = 0; i < READER_COUNT; i++) {
+    jobs[i] = (reader_job) {tree, i, &stop, 0, 0};
+    pthread_create(&threads[i], NULL, reader, &jobs[i]);
+  }
+
+  unsigned seed = 42;
+
+  for (int i = 0; i < 200000; i++) {
+    int value = rand_r(&seed) % KEY_RANGE;
+
+    if (rand_r(&seed) % 2 == 0) {
+      insert(value, tree);
+    } else {
+      remove_value(value, tree);
+    }
+  }
+
+  atomic_store(&stop, 1);
+
+  long lookups = 0;
+  long hits = 0;
+
+  for (int i = 0; i < READER_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+
+    lookups += jobs[i].lookups;
+    hits += jobs[i].hits;
+  }
+
+  printf("%d readers did %ld lookups (%ld hits) during 200000 updates\n", READER_COUNT, lookups, hits);
+  printf("The tree went through %lu versions\n", atomic_load(&tree->epoch) - 1);
+
+  persistent_tree_free(tree);
+
+  return 0;
+}
@@ -0,0 +1,549 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* The list in `./10-linked-lists.c` can only find a value by walking from the
+ * head, so checking whether a value is in the list, or removing the node that holds
+ * it, is O(n). Doing either once for every element turns into O(n^2).
+ *
+ * This exercise keeps an optional **hash index** alongside the list: a table that
+ * maps each value to the node(s) holding it. A hash function turns the value into
+ * a number that picks a slot in the table, so finding it usually only means looking
+ * at one or two slots no matter how long the list is. The list and index are
+ * updated together by `append()`, `prepend()` and the `remove_*()` functions.
+ *
+ * A few details about how the table works:
+ *
+ *  - **Open addressing:** each slot holds a single node pointer. If a value's slot
+ *    is taken, it goes in the next free one after it (**linear probing**), so a
+ *    lookup keeps going until it finds the value or an empty slot.
+ *  - **Control bytes:** next to the slots is an array with one byte per slot. It's
+ *    either `EMPTY`, `DELETED`, or 7 bits of the value's hash. A lookup compares its
+ *    own 7 bits against 16 control bytes at once (a single SSE2 instruction), and
+ *    only follows the node pointer when they match, which rules out almost every
+ *    other value without touching its node.
+ *  - **Tombstones:** removing a value can't just empty its slot, since that would
+ *    stop lookups for values that were placed after it. The slot is marked
+ *    `DELETED` instead, which lookups skip over but inserts can reuse.
+ *  - **Incremental resizing:** once the table is 7/8 full it needs a bigger one.
+ *    Copying everything over in one go would make that one insert very slow, so
+ *    instead the old table is kept around, and every following insert or remove
+ *    moves a few more of its slots into the new one. Until that's done, lookups
+ *    check both tables.
+ *
+ * The list is doubly linked here, so that a node found through the index can be
+ * unlinked without walking from the head to find the node before it.
+ */
+#define EMPTY 0x80
+#define DELETED 0xfe
+#define GROUP_SIZE 16
+#define MIGRATE_STEP 16
+
+typedef struct node {
+  int value;
+  struct node *prev;
+  struct node *next;
+} node;
+
+/* `control` has `GROUP_SIZE` extra bytes at the end that mirror the first ones,
+ * so a group of 16 can always be read in one go, even at the end of the table.
+ */
+typedef struct {
+  unsigned char *control;
+  node **slots;
+  size_t capacity;
+  size_t used;
+} table;
+
+typedef struct {
+  table current;
+  table old;
+  size_t migrated;
+  size_t count;
+} hash_index;
+
+typedef struct {
+  node *head;
+  node *tail;
+  size_t length;
+  hash_index *index;
+} list;
+
+/* Mixes the bits of the value so that values that are close together (like 1, 2,
+ * 3) end up spread across the table. This is the last step of MurmurHash3.
+ */
+uint64_t hash(int value) {
+  uint64_t h = (uint32_t) value;
+
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+
+  return h;
+}
+
+// Returns a bit for each of the 16 control bytes starting at `control` that equal `byte`
+unsigned match_group(unsigned char *control, unsigned char byte) {
+#ifdef __SSE2__
+  __m128i group = _mm_loadu_si128((__m128i *) control);
+
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) byte)));
+#else
+  unsigned mask = 0;
+
+  for (int i = 0; i < GROUP_SIZE; i++) {
+    mask |= (unsigned) (control[i] == byte) << i;
+  }
+
+  return mask;
+#endif
+}
+
+// Returns a bit for each of the 16 control bytes that are `EMPTY` or `DELETED`
+unsigned match_free(unsigned char *control) {
+#ifdef __SSE2__
+  return _mm_movemask_epi8(_mm_loadu_si128((__m128i *) control));
+#else
+  unsigned mask = 0;
+
+  for (int i = 0; i < GROUP_SIZE; i++) {
+    mask |= (unsigned) (control[i] >> 7) << i;
+  }
+
+  return mask;
+#endif
+}
+
+int lowest_bit(unsigned mask) {
+  return __builtin_ctz(mask);
+}
+
+// `capacity` must be a power of two and at least `GROUP_SIZE`
+table table_new(size_t capacity) {
+  table t;
+
+  t.control = malloc(capacity + GROUP_SIZE);
+  t.slots = malloc(capacity * sizeof(node *));
+  t.capacity = capacity;
+  t.used = 0;
+
+  memset(t.control, EMPTY, capacity + GROUP_SIZE);
+
+  return t;
+}
+
+void table_free(table *t) {
+  free(t->control);
+  free(t->slots);
+
+  t->control = NULL;
+  t->slots = NULL;
+  t->capacity = 0;
+  t->used = 0;
+}
+
+void set_control(table *t, size_t i, unsigned char byte) {
+  t->control[i] = byte;
+
+  if (i < GROUP_SIZE) {
+    t->control[t->capacity + i] = byte;
+  }
+}
+
+/* Returns the slot holding `target`, or if `target` is NULL, the slot of any node
+ * holding `value`. Returns -1 if there isn't one.
+ */
+long table_find(table *t, uint64_t h, int value, node *target) {
+  if (t->capacity == 0) {
+    return -1;
+  }
+
+  size_t mask = t->capacity - 1;
+  size_t position = (h >> 7) & mask;
+  unsigned char fragment = h & 0x7f;
+
+  while (1) {
+    unsigned candidates = match_group(t->control + position, fragment);
+
+    while (candidates != 0) {
+      size_t i = (position + lowest_bit(candidates)) & mask;
+      node *n = t->slots[i];
+
+      if (target != NULL ? n == target : n->value == value) {
+        return (long) i;
+      }
+
+      candidates &= candidates - 1;
+    }
+
+    // An empty slot means the probe sequence ends here
+    if (match_group(t->control + position, EMPTY) != 0) {
+      return -1;
+    }
+
+    position = (position + GROUP_SIZE) & mask;
+  }
+}
+
+void table_insert(table *t, uint64_t h, node *n) {
+  size_t mask = t->capacity - 1;
+  size_t position = (h >> 7) & mask;
+  unsigned free_slots;
+
+  while ((free_slots = match_free(t->control + position)) == 0) {
+    position = (position + GROUP_SIZE) & mask;
+  }
+
+  size_t i = (position + lowest_bit(free_slots)) & mask;
+
+  if (t->control[i] == EMPTY) {
+    t->used++;
+  }
+
+  set_control(t, i, h & 0x7f);
+  t->slots[i] = n;
+}
+
+// Moves up to `MIGRATE_STEP` slots from the old table into the current one
+void migrate(hash_index *index) {
+  table *old = &index->old;
+
+  if (old->capacity == 0) {
+    return;
+  }
+
+  size_t end = index->migrated + MIGRATE_STEP;
+
+  for (; index->migrated < end && index->migrated < old->capacity; index->migrated++) {
+    size_t i = index->migrated;
+
+    if ((old->control[i] & 0x80) == 0) {
+      node *n = old->slots[i];
+
+      table_insert(&index->current, hash(n->value), n);
+      // So a lookup that falls through to the old table can't find it there too
+      set_control(old, i, DELETED);
+    }
+  }
+
+  if (index->migrated == old->capacity) {
+    table_free(old);
+  }
+}
+
+/* Before inserting, makes sure the current table has room. When it's full, it
+ * becomes the old table and a new one takes its place. It's twice as big, unless
+ * most of the used slots were tombstones, in which case the same size is enough.
+ */
+void reserve(hash_index *index) {
+  table *current = &index->current;
+
+  if ((current->used + 1) * 8 <= current->capacity * 7) {
+    return;
+  }
+
+  // Finish any move that's still going so there's only ever one old table
+  while (index->old.capacity != 0) {
+    migrate(index);
+  }
+
+  size_t capacity = index->count * 2 >= current->capacity ? current->capacity * 2 : current->capacity;
+
+  index->old = *current;
+  index->migrated = 0;
+  *current = table_new(capacity);
+}
+
+hash_index* hash_index_new() {
+  hash_index *index = malloc(sizeof(hash_index));
+
+  index->current = table_new(GROUP_SIZE);
+  index->old = (table) {NULL, NULL, 0, 0};
+  index->migrated = 0;
+  index->count = 0;
+
+  return index;
+}
+
+void hash_index_free(hash_index *index) {
+  table_free(&index->current);
+  table_free(&index->old);
+  free(index);
+}
+
+void index_add(hash_index *index, node *n) {
+  reserve(index);
+  migrate(index);
+  table_insert(&index->current, hash(n->value), n);
+
+  index->count++;
+}
+
+void index_remove(hash_index *index, node *n) {
+  uint64_t h = hash(n->value);
+  long i = table_find(&index->current, h, n->value, n);
+
+  if (i >= 0) {
+    set_control(&index->current, i, DELETED);
+  } else if ((i = table_find(&index->old, h, n->value, n)) >= 0) {
+    set_control(&index->old, i, DELETED);
+  }
+
+  index->count--;
+
+  migrate(index);
+}
+
+node* index_find(hash_index *index, int value) {
+  uint64_t h = hash(value);
+  long i = table_find(&index->current, h, value, NULL);
+
+  if (i >= 0) {
+    return index->current.slots[i];
+  }
+
+  i = table_find(&index->old, h, value, NULL);
+
+  return i >= 0 ? index->old.slots[i] : NULL;
+}
+
+/* Pass a non-zero `indexed` to keep a hash index for the list. Without one, it
+ * behaves just like the list in `./10-linked-lists.c`.
+ */
+list* list_new(int indexed) {
+  list *l = malloc(sizeof(list));
+
+  l->head = NULL;
+  l->tail = NULL;
+  l->length = 0;
+  l->index = indexed ? hash_index_new() : NULL;
+
+  return l;
+}
+
+node* getNode(int value) {
+  node *n = malloc(sizeof(node));
+
+  n->value = value;
+  n->prev = NULL;
+  n->next = NULL;
+
+  return n;
+}
+
+/* Adds a node containing the given value to the end of the list
+ */
+void append(int value, list *l) {
+  node *n = getNode(value);
+
+  n->prev = l->tail;
+
+  if (l->tail != NULL) {
+    l->tail->next = n;
+  } else {
+    l->head = n;
+  }
+
+  l->tail = n;
+  l->length++;
+
+  if (l->index != NULL) {
+    index_add(l->index, n);
+  }
+}
+
+/* Adds a node containing the given value to the beginning of the list
+ */
+void prepend(int value, list *l) {
+  node *n = getNode(value);
+
+  n->next = l->head;
+
+  if (l->head != NULL) {
+    l->head->prev = n;
+  } else {
+    l->tail = n;
+  }
+
+  l->head = n;
+  l->length++;
+
+  if (l->index != NULL) {
+    index_add(l->index, n);
+  }
+}
+
+// Unlinks `n` from the list (and the index) and frees it
+void remove_node(node *n, list *l) {
+  if (n->prev != NULL) {
+    n->prev->next = n->next;
+  } else {
+    l->head = n->next;
+  }
+
+  if (n->next != NULL) {
+    n->next->prev = n->prev;
+  } else {
+    l->tail = n->prev;
+  }
+
+  l->length--;
+
+  if (l->index != NULL) {
+    index_remove(l->index, n);
+  }
+
+  free(n);
+}
+
+/* Returns a node containing the given value, or NULL if there isn't one
+ */
+node* find(int value, list *l) {
+  if (l->index != NULL) {
+    return index_find(l->index, value);
+  }
+
+  node *current = l->head;
+
+  while (current != NULL && current->value != value) {
+    current = current->next;
+  }
+
+  return current;
+}
+
+/* Removes the first node at the beginning of the list
+ */
+void remove_first(list *l) {
+  if (l->head != NULL) {
+    remove_node(l->head, l);
+  }
+}
+
+/* Removes the node at the end of the list
+ */
+void remove_last(list *l) {
+  if (l->tail != NULL) {
+    remove_node(l->tail, l);
+  }
+}
+
+/* Removes the node at the given index
+ */
+void remove_at(size_t i, list *l) {
+  node *current = l->head;
+
+  for (size_t j = 0; j < i && current != NULL; j++) {
+    current = current->next;
+  }
+
+  if (current != NULL) {
+    remove_node(current, l);
+  }
+}
+
+/* Removes a node containing the given value, if there is one. With an index, it
+ * isn't specified which one when several nodes have the same value.
+ */
+void remove_value(int value, list *l) {
+  node *n = find(value, l);
+
+  if (n != NULL) {
+    remove_node(n, l);
+  }
+}
+
+void list_free(list *l) {
+  while (l->head != NULL) {
+    node *next = l->head->next;
+    free(l->head);
+    l->head = next;
+  }
+
+  if (l->index != NULL) {
+    hash_index_free(l->index);
+  }
+
+  free(l);
+}
+
+/* A "dedupe and evict" loop: keep the most recent `capacity` distinct values,
+ * oldest first. A value that's seen again is moved to the end, and when the list is
+ * too long the oldest one is dropped. Returns how long it took in seconds.
+ */
+double dedupe_and_evict(int indexed, int count, int capacity) {
+  list *l = list_new(indexed);
+  unsigned seed = 1;
+
+  clock_t start = clock();
+
+  for (int i = 0; i < count; i++) {
+    seed = seed * 1103515245 + 12345;
+
+    int value = (int) ((seed >> 8) % (unsigned) (capacity * 2));
+
+    remove_value(value, l);
+    append(value, l);
+
+    if (l->length > (size_t) capacity) {
+      remove_first(l);
+    }
+  }
+
+  double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+  list_free(l);
+
+  return seconds;
+}
+
+int main() {
+  list *l = list_new(1);
+
+  for (int i = 0; i < 10; i++) {
+    append(i, l);
+  }
+
+  prepend(-1, l);
+  remove_value(4, l);
+  remove_first(l);
+  remove_last(l);
+  remove_at(2, l);
+
+  for (node *current = l->head; current != NULL; current = current->next) {
+    printf("%d ", current->value);
+  }
+
+  printf("\nfind(4) = %p, find(7) = %p (holds %d)\n", (void *) find(4, l), (void *) find(7, l), find(7, l)->value);
+
+  list_free(l);
+
+  printf("\n----------------\n\n");
+
+  int sizes[] = {1000, 10000, 100000};
+
+  for (int s = 0; s < 3; s++) {
+    int capacity = sizes[s];
+    int count = capacity * 10;
+
+    printf("%d values, keeping %d: ", count, capacity);
+    printf("%.3fs with an index", dedupe_and_evict(1, count, capacity));
+
+    // The unindexed version is quadratic, so only run it where it'll finish quickly
+    if (capacity <= 10000) {
+      printf(", %.3fs without", dedupe_and_evict(0, count, capacity));
+    }
+
+    printf("\n");
+  }
+
+  return 0;
+}